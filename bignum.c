@@ -12,14 +12,10 @@
 
 ulong bitlen(Number n)
 {
-	if (n.len) {
-		assert(n.d[n.len-1]);
-		for (uint i = CHUNKBITS; i > 0; i--) {
-			if (n.d[n.len-1] & (1UL << (i-1)))
-				return (ulong)(n.len - 1)*CHUNKBITS + i;
-		}
-	}
-	return 0;
+	if (iszero(n))
+		return 0;
+	assert(n.d[n.len-1]);
+	return (ulong)n.len*CHUNKBITS - __builtin_clzl(n.d[n.len-1]);
 }
 
 Number number(long n)
@@ -80,12 +76,13 @@ void assign(Number *dst, Number src)
 	if (dst->d == src.d)
 		return;
 	if (dst->len < src.len)
-		extend(dst, dst->len - src.len);
+		extend(dst, src.len - dst->len);
 	for (uint i = 0; i < src.len; i++)
 		dst->d[i] = src.d[i];
 	for (uint i = src.len; i < dst->len; i++)
 		dst->d[i] = 0;
 	dst->len = src.len;
+	dst->neg = src.neg;
 }
 
 void clear(Number *n)
@@ -162,7 +159,7 @@ static int abscmp(Number a, Number b)
 		return 1;
 	if (a.len < b.len)
 		return -1;
-	for (long i = a.len - 1; i >= 0; i--) {
+	for (long i = (long)a.len - 1; i >= 0; i--) {
 		if (a.d[i] > b.d[i])
 			return 1;
 		if (a.d[i] < b.d[i])
@@ -240,7 +237,7 @@ void lshift(Number *n, uint bits)
 	uint move = bits / CHUNKBITS;
 	if (move) {
 		extend(n, move);
-		for (uint i = n->len; i >= move; i--)
+		for (uint i = n->len - 1; i >= move; i--)
 			n->d[i] = n->d[i-move];
 		for (uint i = 0; i < move; i++)
 			n->d[i] = 0;
@@ -288,6 +285,7 @@ void square(Number *n)
 {
 	if (iszero(*n))
 		return;
+	n->neg = 0;
 	uint l = n->len;
 	extend(n, n->len);
 	Number tmp = {2, 2, (ulong[]){0, 0}, 0};
@@ -326,55 +324,72 @@ void mul(Number *dst, Number src)
 void rem(Number *dst, Number src)
 {
 	assert(!iszero(src));
-	dst->neg ^= src.neg;
+	if (!dst->len)
+		extend(dst, 1); /* cleared numbers are zero */
 	ulong dstlen = bitlen(*dst);
 	ulong srclen = bitlen(src);
-	if (dstlen > srclen)
-		lshift(&src, dstlen - srclen);
+	if (dstlen < srclen)
+		return;
+	Number d = copy(src); /* src may share its buffer with dst */
+	lshift(&d, dstlen - srclen);
 	for (ulong i = dstlen; i >= srclen; i--) {
-		if (abscmp(*dst, src) >= 0)
-			abssub(dst, src, 1);
+		if (abscmp(*dst, d) >= 0)
+			abssub(dst, d, 1);
 		if (i > srclen)
-			rshift(&src, 1);
+			rshift(&d, 1);
 	}
+	clear(&d);
 }
 
 void quo(Number *dst, Number src)
 {
 	assert(!iszero(src));
+	if (!dst->len)
+		extend(dst, 1); /* cleared numbers are zero */
 	dst->neg ^= src.neg;
 	ulong dstlen = bitlen(*dst);
 	ulong srclen = bitlen(src);
-	if (dstlen > srclen)
-		lshift(&src, dstlen - srclen);
+	if (dstlen < srclen)
+		return zero(dst);
+	Number d = copy(src); /* src may share its buffer with dst */
+	lshift(&d, dstlen - srclen);
 	extend(dst, 1); /* dst = remainder, chunk, quotient */
-	uint l = dst->len;
-	dst->len -= 1;
-	for (ulong i = dstlen - 1; i >= srclen - 1; i--) {
-		if (abscmp(*dst, src) >= 0) {
-			abssub(dst, src, 1);
+	for (ulong i = dstlen; i-- > srclen - 1;) {
+		/* the remainder is below bit i+2 and the quotient bits found
+		 * so far are above i+CHUNKBITS, so compare only the chunks below */
+		uint l = (i + 1)/CHUNKBITS + 1;
+		Number r = {l, l, dst->d, 0};
+		shrink(&r);
+		if (abscmp(r, d) >= 0) {
+			abssub(&r, d, 1);
 			dst->d[i/CHUNKBITS + 1] |= 1UL << i%CHUNKBITS;
 		}
 		if (i > srclen - 1)
-			rshift(&src, 1);
+			rshift(&d, 1);
 	}
-	dst->len = l;
+	clear(&d);
 	rshift(dst, srclen - 1 + CHUNKBITS);
 }
 
-/* TODO: do less copying */
+/* truncating division: dst/src is rounded toward zero and
+ * the remainder has the sign of dst
+ * TODO: do less copying */
 void quorem(Number *dst, Number *rem, Number src)
 {
 	if (!rem)
 		return quo(dst, src);
 	assert (!iszero(src));
+	if (!dst->len)
+		extend(dst, 1); /* cleared numbers are zero */
 	ulong dstlen = bitlen(*dst);
 	ulong srclen = bitlen(src);
-	if (dstlen < srclen)
-		return move(rem, dst);
+	if (dstlen < srclen) {
+		assign(rem, *dst);
+		return zero(dst);
+	}
 	Number d = copy(src);
 	Number r = copy(*dst);
-	dst->neg = r.neg = dst->neg ^ src.neg;
+	dst->neg ^= src.neg; /* the remainder keeps the sign of dst */
 	for (uint i = 0; i < dst->len; i++)
 		dst->d[i] = 0;
 	lshift(&d, dstlen - srclen);
@@ -390,11 +405,216 @@ void quorem(Number *dst, Number *rem, Number src)
 	clear(&d);
 }
 
+static int isneg(Number n)
+{
+	return n.neg && !iszero(n);
+}
+
+/* returns the i-th chunk of n in two's complement, chunks must be
+ * visited in order starting from 0 with *carry = isneg(n) */
+static ulong twos(Number n, uint i, ulong *carry)
+{
+	ulong x = i < n.len ? n.d[i] : 0;
+	if (!n.neg)
+		return x;
+	x = ~x + *carry;
+	*carry = *carry && !x;
+	return x;
+}
+
+static ulong bitop1(ulong x, ulong y, char op)
+{
+	switch (op) {
+	case '&': return x & y;
+	case '|': return x | y;
+	default:  return x ^ y;
+	}
+}
+
+/* Numbers are treated as infinite two's complement bit strings */
+static void bitop(Number *dst, Number src, char op)
+{
+	if (!dst->len)
+		extend(dst, 1); /* cleared numbers are zero */
+	if (dst->d == src.d) {
+		if (op == '^')
+			zero(dst);
+		return;
+	}
+	int dneg = isneg(*dst), sneg = isneg(src);
+	if (!dneg && !sneg) {
+		/* the common case: plain loops that the compiler can vectorize */
+		if (op == '&') {
+			uint l = dst->len < src.len ? dst->len : src.len;
+			for (uint i = 0; i < l; i++)
+				dst->d[i] &= src.d[i];
+			for (uint i = l; i < dst->len; i++)
+				dst->d[i] = 0;
+			dst->len = l ? l : 1;
+		} else {
+			if (dst->len < src.len)
+				extend(dst, src.len - dst->len);
+			if (op == '|') {
+				for (uint i = 0; i < src.len; i++)
+					dst->d[i] |= src.d[i];
+			} else {
+				for (uint i = 0; i < src.len; i++)
+					dst->d[i] ^= src.d[i];
+			}
+		}
+		dst->neg = 0;
+		shrink(dst);
+		return;
+	}
+	/* the extra chunk holds the sign */
+	uint l = (dst->len > src.len ? dst->len : src.len) + 1;
+	extend(dst, l - dst->len);
+	int neg = bitop1(dneg, sneg, op);
+	ulong dc = dneg, sc = sneg, rc = neg;
+	dst->neg = dneg;
+	src.neg = sneg;
+	for (uint i = 0; i < l; i++) {
+		ulong r = bitop1(twos(*dst, i, &dc), twos(src, i, &sc), op);
+		if (neg) {
+			/* back to sign and magnitude */
+			r = ~r + rc;
+			rc = rc && !r;
+		}
+		dst->d[i] = r;
+	}
+	dst->neg = neg;
+	shrink(dst);
+}
+
+void and(Number *dst, Number src)
+{
+	bitop(dst, src, '&');
+}
+
+void or(Number *dst, Number src)
+{
+	bitop(dst, src, '|');
+}
+
+void xor(Number *dst, Number src)
+{
+	bitop(dst, src, '^');
+}
+
+/* ~n == -n - 1 */
+void not(Number *n)
+{
+	negate(n);
+	dec(n, 1);
+}
+
+static int absbit(Number n, ulong bit)
+{
+	if (bit/CHUNKBITS >= n.len)
+		return 0;
+	return (n.d[bit/CHUNKBITS] >> bit%CHUNKBITS) & 1;
+}
+
+static void absputbit(Number *n, ulong bit, int v)
+{
+	uint i = bit/CHUNKBITS;
+	if (i >= n->len) {
+		if (!v)
+			return;
+		extend(n, i + 1 - n->len);
+	}
+	if (v)
+		n->d[i] |= 1UL << bit%CHUNKBITS;
+	else
+		n->d[i] &= ~(1UL << bit%CHUNKBITS);
+	shrink(n);
+}
+
+/* For negative n, bit k of n is the inverse of bit k of |n|-1, so the
+ * bit operations on negative numbers work on |n|-1 in place */
+static void putbit(Number *n, ulong bit, int v)
+{
+	if (!n->len)
+		extend(n, 1); /* cleared numbers are zero */
+	if (!isneg(*n)) {
+		n->neg = 0;
+		return absputbit(n, bit, v);
+	}
+	n->neg = 0;
+	dec(n, 1);
+	n->neg = 0; /* dec() leaves a negative zero behind for n == 1 */
+	absputbit(n, bit, !v);
+	inc(n, 1);
+	n->neg = 1;
+}
+
+void setbit(Number *n, ulong bit)
+{
+	putbit(n, bit, 1);
+}
+
+void clrbit(Number *n, ulong bit)
+{
+	putbit(n, bit, 0);
+}
+
+int testbit(Number n, ulong bit)
+{
+	if (!isneg(n))
+		return absbit(n, bit);
+	/* |n|-1 differs from |n| only up to the lowest set bit */
+	ulong t = ctz(n);
+	if (bit < t)
+		return 0;
+	if (bit == t)
+		return 1;
+	return !absbit(n, bit);
+}
+
+/* negative numbers have infinitely many ones, ~0 is returned for them */
+ulong popcount(Number n)
+{
+	if (isneg(n))
+		return ~0UL;
+	ulong c = 0;
+	for (uint i = 0; i < n.len; i++)
+		c += __builtin_popcountl(n.d[i]);
+	return c;
+}
+
+/* the number of differing bits, ~0 if the signs differ */
+ulong hamming(Number a, Number b)
+{
+	int aneg = isneg(a), bneg = isneg(b);
+	if (aneg != bneg)
+		return ~0UL;
+	a.neg = aneg;
+	b.neg = bneg;
+	uint l = a.len > b.len ? a.len : b.len;
+	ulong ac = aneg, bc = bneg, c = 0;
+	for (uint i = 0; i < l; i++)
+		c += __builtin_popcountl(twos(a, i, &ac) ^ twos(b, i, &bc));
+	return c;
+}
+
+/* the number of trailing zero bits, zero has infinitely many so ~0 is
+ * returned for it */
+ulong ctz(Number n)
+{
+	if (iszero(n))
+		return ~0UL;
+	uint i = 0;
+	while (!n.d[i])
+		i++;
+	return (ulong)i*CHUNKBITS + __builtin_ctzl(n.d[i]);
+}
+
 static int read10(Number *n, char *s, uint l)
 {
 	if (!n->len)
 		extend(n, 1);
 	Number ten = {1, 1, (ulong[]){10}, 0};
+	Number digit = {1, 1, (ulong[]){0}, 0};
 	for (uint i = 0; i < l; i++) {
 		char c = s[i];
 		if (c < '0' || c > '9') {
@@ -402,7 +622,8 @@ static int read10(Number *n, char *s, uint l)
 			return -1;
 		}
 		mul(n, ten);
-		n->d[0] += c - '0';
+		digit.d[0] = c - '0';
+		absadd(n, digit);
 	}
 	return 0;
 }
@@ -32,6 +32,16 @@ void   mul(Number *dst, Number src);
 void   rem(Number *dst, Number src);
 void   quo(Number *dst, Number src);
 void   quorem(Number *dst, Number *rem, Number src);
+void   and(Number *dst, Number src);
+void   or(Number *dst, Number src);
+void   xor(Number *dst, Number src);
+void   not(Number *n);
+void   setbit(Number *n, ulong bit);
+void   clrbit(Number *n, ulong bit);
+int    testbit(Number n, ulong bit);
+ulong  popcount(Number n);
+ulong  hamming(Number a, Number b);
+ulong  ctz(Number n);
 int    read(Number *n, char *s);
 void   print10(Number n);
 void   print16(Number n);
@@ -0,0 +1,719 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bignum.h"
+
+
+/* Randomized differential tests: every operation is checked against
+ * a slow but obviously correct reference implementation that works
+ * on plain limb arrays.
+ *
+ * usage: difftest [SEED [ITERATIONS]]
+ *
+ * Most operands are short, but every BIGODDS-th one is between
+ * MAXLIMBS/2 and MAXLIMBS chunks long, to get past the thresholds of
+ * asymptotically fast algorithms. Build with -DMAXLIMBS=N or
+ * -DBIGODDS=N to change that. */
+
+#define CHUNKBITS (sizeof(ulong)*8)
+
+#ifndef MAXLIMBS
+#define MAXLIMBS 384 /* the maximum length of a random operand */
+#endif
+#define SMALLLIMBS 24
+#ifndef BIGODDS
+#define BIGODDS    256
+#endif
+#define MAXSHIFT   (5*CHUNKBITS)
+#define REFLEN     (2*MAXLIMBS + 8)
+
+typedef unsigned __int128 uvlong;
+
+typedef struct {
+	uint len;
+	ulong d[REFLEN];
+	uchar neg;
+} Ref;
+
+static ulong seed, iter;
+static char *opname;
+static Ref opa, opb;
+
+static ulong state;
+
+static ulong rnd(void)
+{
+	/* xorshift64* */
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717UL;
+}
+
+static void refnorm(Ref *r)
+{
+	while (r->len > 1 && !r->d[r->len-1])
+		r->len -= 1;
+	if (r->len == 1 && !r->d[0])
+		r->neg = 0;
+}
+
+static int refzero(Ref *r)
+{
+	return r->len == 1 && !r->d[0];
+}
+
+static void refset(Ref *r, ulong n)
+{
+	memset(r, 0, sizeof(*r));
+	r->len = 1;
+	r->d[0] = n;
+}
+
+static int refcmpabs(Ref *a, Ref *b)
+{
+	if (a->len != b->len)
+		return a->len > b->len ? 1 : -1;
+	for (long i = (long)a->len - 1; i >= 0; i--) {
+		if (a->d[i] != b->d[i])
+			return a->d[i] > b->d[i] ? 1 : -1;
+	}
+	return 0;
+}
+
+/* r = |a| + |b| */
+static void refaddabs(Ref *r, Ref *a, Ref *b)
+{
+	Ref s = {};
+	uvlong carry = 0;
+	s.len = (a->len > b->len ? a->len : b->len) + 1;
+	for (uint i = 0; i < s.len; i++) {
+		carry += (uvlong)a->d[i] + b->d[i];
+		s.d[i] = carry;
+		carry >>= CHUNKBITS;
+	}
+	s.neg = r->neg;
+	*r = s;
+	refnorm(r);
+}
+
+/* r = |a| - |b|, |a| >= |b| */
+static void refsubabs(Ref *r, Ref *a, Ref *b)
+{
+	Ref s = {};
+	ulong borrow = 0;
+	s.len = a->len;
+	for (uint i = 0; i < s.len; i++) {
+		uvlong t = (uvlong)a->d[i] - b->d[i] - borrow;
+		s.d[i] = t;
+		borrow = (t >> CHUNKBITS) != 0;
+	}
+	s.neg = r->neg;
+	*r = s;
+	refnorm(r);
+}
+
+static void refadd(Ref *r, Ref *a, Ref *b)
+{
+	if (a->neg == b->neg) {
+		r->neg = a->neg;
+		refaddabs(r, a, b);
+	} else if (refcmpabs(a, b) >= 0) {
+		r->neg = a->neg;
+		refsubabs(r, a, b);
+	} else {
+		r->neg = b->neg;
+		refsubabs(r, b, a);
+	}
+}
+
+static void refsub(Ref *r, Ref *a, Ref *b)
+{
+	Ref nb = *b;
+	nb.neg = !nb.neg;
+	refadd(r, a, &nb);
+}
+
+static void refmul(Ref *r, Ref *a, Ref *b)
+{
+	Ref p = {};
+	p.len = a->len + b->len;
+	for (uint i = 0; i < a->len; i++) {
+		uvlong carry = 0;
+		for (uint j = 0; j < b->len; j++) {
+			carry += (uvlong)a->d[i] * b->d[j] + p.d[i+j];
+			p.d[i+j] = carry;
+			carry >>= CHUNKBITS;
+		}
+		p.d[i+b->len] = carry;
+	}
+	p.neg = a->neg ^ b->neg;
+	*r = p;
+	refnorm(r);
+}
+
+static void refshl(Ref *r, Ref *a, uint bits)
+{
+	Ref s = {};
+	uint move = bits / CHUNKBITS, shift = bits % CHUNKBITS;
+	s.len = a->len + move + 1;
+	for (uint i = 0; i < a->len; i++) {
+		s.d[i+move] |= a->d[i] << shift;
+		if (shift)
+			s.d[i+move+1] = a->d[i] >> (CHUNKBITS - shift);
+	}
+	s.neg = a->neg;
+	*r = s;
+	refnorm(r);
+}
+
+static void refshr(Ref *r, Ref *a, uint bits)
+{
+	Ref s = {};
+	uint drop = bits / CHUNKBITS, shift = bits % CHUNKBITS;
+	s.len = 1;
+	if (drop < a->len) {
+		s.len = a->len - drop;
+		for (uint i = 0; i < s.len; i++) {
+			s.d[i] = a->d[i+drop] >> shift;
+			if (shift && i+drop+1 < a->len)
+				s.d[i] |= a->d[i+drop+1] << (CHUNKBITS - shift);
+		}
+	}
+	s.neg = a->neg;
+	*r = s;
+	refnorm(r);
+}
+
+static ulong refbitlen(Ref *a)
+{
+	ulong n = (ulong)a->len * CHUNKBITS;
+	for (ulong top = a->d[a->len-1]; n && !(top >> (CHUNKBITS-1)); top <<= 1)
+		n--;
+	return refzero(a) ? 0 : n;
+}
+
+/* truncating bit-serial long division: a = q*b + r, |r| < |b|,
+ * r has the sign of a */
+static void refdivmod(Ref *q, Ref *r, Ref *a, Ref *b)
+{
+	refset(q, 0);
+	refset(r, 0);
+	q->len = a->len;
+	for (long i = refbitlen(a) - 1; i >= 0; i--) {
+		/* r = 2*r + bit i of a, in place: this runs for every bit */
+		ulong carry = (a->d[i/CHUNKBITS] >> i%CHUNKBITS) & 1;
+		for (uint j = 0; j < r->len; j++) {
+			ulong top = r->d[j] >> (CHUNKBITS-1);
+			r->d[j] = r->d[j] << 1 | carry;
+			carry = top;
+		}
+		if (carry)
+			r->d[r->len++] = carry;
+		refnorm(r);
+		if (refcmpabs(r, b) >= 0) {
+			ulong borrow = 0;
+			for (uint j = 0; j < r->len; j++) {
+				uvlong t = (uvlong)r->d[j] - b->d[j] - borrow;
+				r->d[j] = t;
+				borrow = (t >> CHUNKBITS) != 0;
+			}
+			refnorm(r);
+			q->d[i/CHUNKBITS] |= 1UL << i%CHUNKBITS;
+		}
+	}
+	q->neg = a->neg ^ b->neg;
+	r->neg = a->neg;
+	refnorm(q);
+	refnorm(r);
+}
+
+/* r = a as a len chunk two's complement bit string */
+static void reftwos(Ref *r, Ref *a, uint len)
+{
+	uvlong carry = a->neg;
+	*r = *a;
+	r->len = len;
+	for (uint i = 0; i < len && a->neg; i++) {
+		carry += (ulong)~a->d[i];
+		r->d[i] = carry;
+		carry >>= CHUNKBITS;
+	}
+}
+
+static void reffromtwos(Ref *r)
+{
+	r->neg = r->d[r->len-1] >> (CHUNKBITS-1);
+	reftwos(r, r, r->len); /* negation is its own inverse */
+	refnorm(r);
+}
+
+static void refbitop(Ref *r, Ref *a, Ref *b, char op)
+{
+	Ref x, y;
+	uint len = (a->len > b->len ? a->len : b->len) + 1;
+	reftwos(&x, a, len);
+	reftwos(&y, b, len);
+	for (uint i = 0; i < len; i++) {
+		switch (op) {
+		case '&': x.d[i] &= y.d[i]; break;
+		case '|': x.d[i] |= y.d[i]; break;
+		case '^': x.d[i] ^= y.d[i]; break;
+		}
+	}
+	*r = x;
+	reffromtwos(r);
+}
+
+static void refand(Ref *r, Ref *a, Ref *b) { refbitop(r, a, b, '&'); }
+static void refor(Ref *r, Ref *a, Ref *b)  { refbitop(r, a, b, '|'); }
+static void refxor(Ref *r, Ref *a, Ref *b) { refbitop(r, a, b, '^'); }
+
+static int reftestbit(Ref *a, ulong bit)
+{
+	Ref x;
+	reftwos(&x, a, REFLEN);
+	return (x.d[bit/CHUNKBITS] >> bit%CHUNKBITS) & 1;
+}
+
+static void refputbit(Ref *r, Ref *a, ulong bit, int v)
+{
+	reftwos(r, a, REFLEN);
+	r->d[bit/CHUNKBITS] &= ~(1UL << bit%CHUNKBITS);
+	r->d[bit/CHUNKBITS] |= (ulong)v << bit%CHUNKBITS;
+	reffromtwos(r);
+}
+
+static ulong refhamming(Ref *a, Ref *b)
+{
+	Ref x, y;
+	ulong c = 0;
+	if ((a->neg && !refzero(a)) != (b->neg && !refzero(b)))
+		return ~0UL;
+	uint len = (a->len > b->len ? a->len : b->len) + 1; /* the rest is sign */
+	reftwos(&x, a, len);
+	reftwos(&y, b, len);
+	for (ulong i = 0; i < len*CHUNKBITS; i++)
+		c += ((x.d[i/CHUNKBITS] ^ y.d[i/CHUNKBITS]) >> i%CHUNKBITS) & 1;
+	return c;
+}
+
+static void refgen(Ref *r)
+{
+	memset(r, 0, sizeof(*r));
+	r->len = 1 + rnd() % SMALLLIMBS;
+	if (rnd() % BIGODDS == 0)
+		r->len = MAXLIMBS/2 + rnd() % (MAXLIMBS - MAXLIMBS/2 + 1);
+	else if (rnd() % 4 == 0)
+		r->len = 1; /* small numbers are special in a lot of places */
+	for (uint i = 0; i < r->len; i++) {
+		switch (rnd() % 6) {
+		case 0: r->d[i] = 0; break;
+		case 1: r->d[i] = ~0UL; break;
+		case 2: r->d[i] = 1UL << rnd()%CHUNKBITS; break;
+		case 3: r->d[i] = rnd() & rnd() & rnd(); break;
+		default: r->d[i] = rnd();
+		}
+	}
+	if (rnd() % 16 == 0)
+		refset(r, 0);
+	r->neg = rnd() % 2;
+	refnorm(r);
+}
+
+static char *refhex(Ref *r)
+{
+	static char buf[4][REFLEN*16 + 8];
+	static uint next;
+	char *s = buf[next++ % 4], *p = s;
+	if (r->neg)
+		*p++ = '-';
+	p += sprintf(p, "0x%lx", r->d[r->len-1]);
+	for (long i = (long)r->len - 2; i >= 0; i--)
+		p += sprintf(p, "%016lx", r->d[i]);
+	return s;
+}
+
+static char *refdec(Ref *r)
+{
+	static char buf[REFLEN*20 + 8];
+	ulong base = 10000000000000000000UL; /* 10^19 */
+	Ref t = *r;
+	char *p = buf + sizeof(buf) - 1;
+	*p = '\0';
+	do {
+		uvlong rem = 0;
+		for (long i = (long)t.len - 1; i >= 0; i--) {
+			rem = rem << CHUNKBITS | t.d[i];
+			t.d[i] = rem / base;
+			rem %= base;
+		}
+		refnorm(&t);
+		for (int k = 0; k < 19; k++) {
+			*--p = '0' + rem%10;
+			rem /= 10;
+		}
+	} while (!refzero(&t));
+	while (p[0] == '0' && p[1])
+		p++;
+	if (r->neg)
+		*--p = '-';
+	return p;
+}
+
+static void report(char *what)
+{
+	printf("FAIL: %s (%s), seed %lu, iteration %lu\n", opname, what, seed, iter);
+	printf("a    = %s\n", refhex(&opa));
+	printf("b    = %s\n", refhex(&opb));
+}
+
+static void fail(char *what, Number got, Ref *want)
+{
+	report(what);
+	printf("want = %s\n", refhex(want));
+	printf("got  = ");
+	if (got.len && got.len <= got.cap) {
+		print16(got);
+		printf("len=%u cap=%u\n", got.len, got.cap);
+	} else {
+		printf("invalid: len=%u cap=%u\n", got.len, got.cap);
+	}
+	exit(1);
+}
+
+static void failint(char *what, long got, long want)
+{
+	report(what);
+	printf("want = %ld\ngot  = %ld\n", want, got);
+	exit(1);
+}
+
+/* check that n holds exactly r, including the normalization invariants;
+ * results must never come back cleared, even for cleared inputs */
+static void check(Number n, Ref *r, int checksign, char *what)
+{
+	if (!n.len)
+		fail("left cleared", n, r);
+	if (iszero(n) && refzero(r))
+		return;
+	if (n.len != r->len || n.len > n.cap)
+		fail(what, n, r);
+	for (uint i = 0; i < n.len; i++) {
+		if (n.d[i] != r->d[i])
+			fail(what, n, r);
+	}
+	if (checksign && n.neg != r->neg)
+		fail(what, n, r);
+}
+
+static Number load(Ref *r)
+{
+	Number n = number(0);
+	if (read(&n, refhex(r)))
+		fail("read16", n, r);
+	check(n, r, 1, "read16");
+	return n;
+}
+
+static void testbin(char *name, void (*f)(Number *, Number), void (*ref)(Ref *, Ref *, Ref *))
+{
+	Ref want;
+	opname = name;
+	Number a = load(&opa), b = load(&opb);
+	f(&a, b);
+	ref(&want, &opa, &opb);
+	check(a, &want, 1, "result");
+	check(b, &opb, 1, "operand modified");
+	clear(&a);
+	clear(&b);
+	/* aliased operands */
+	a = load(&opa);
+	f(&a, a);
+	ref(&want, &opa, &opa);
+	check(a, &want, 1, "aliased");
+	clear(&a);
+}
+
+static void testassign(void)
+{
+	Number a = load(&opa), b = load(&opb);
+	opname = "assign";
+	assign(&a, b);
+	check(a, &opb, 1, "result");
+	check(b, &opb, 1, "operand modified");
+	clear(&a);
+	clear(&b);
+}
+
+static void testshift(void)
+{
+	Ref want;
+	uint bits = rnd() % MAXSHIFT;
+	Number a = load(&opa);
+	opname = "lshift";
+	lshift(&a, bits);
+	refshl(&want, &opa, bits);
+	check(a, &want, 1, "result");
+	opname = "rshift";
+	rshift(&a, bits);
+	check(a, &opa, 1, "lshift+rshift");
+	rshift(&a, bits);
+	refshr(&want, &opa, bits);
+	check(a, &want, 1, "result");
+	clear(&a);
+}
+
+static void testsmall(void)
+{
+	Ref want, small;
+	refgen(&small);
+	refset(&small, small.d[0]);
+	Number a = load(&opa);
+	opname = "inc";
+	inc(&a, small.d[0]);
+	refadd(&want, &opa, &small);
+	check(a, &want, 1, "result");
+	opname = "dec";
+	dec(&a, small.d[0]);
+	check(a, &opa, 1, "inc+dec");
+	clear(&a);
+}
+
+static void testsquare(void)
+{
+	Ref want;
+	Number a = load(&opa);
+	opname = "square";
+	square(&a);
+	refmul(&want, &opa, &opa);
+	check(a, &want, 1, "result");
+	clear(&a);
+}
+
+static void testdiv(void)
+{
+	Ref q, r;
+	if (refzero(&opb))
+		return;
+	refdivmod(&q, &r, &opa, &opb);
+	Number a = load(&opa), b = load(&opb), m = number(0);
+	opname = "quorem";
+	quorem(&a, &m, b);
+	check(a, &q, 1, "quotient");
+	check(m, &r, 1, "remainder");
+	check(b, &opb, 1, "operand modified");
+	mul(&a, b);
+	add(&a, m);
+	check(a, &opa, 1, "a != q*b + r");
+	clear(&a);
+	a = load(&opa);
+	opname = "quo";
+	quo(&a, b);
+	check(a, &q, 1, "quotient");
+	check(b, &opb, 1, "operand modified");
+	clear(&a);
+	a = load(&opa);
+	opname = "rem";
+	rem(&a, b);
+	check(a, &r, 1, "remainder");
+	check(b, &opb, 1, "operand modified");
+	clear(&a);
+	/* the remainder in place of the divisor */
+	a = load(&opa);
+	opname = "quorem";
+	quorem(&a, &b, b);
+	check(a, &q, 1, "quotient, aliased remainder");
+	check(b, &r, 1, "aliased remainder");
+	clear(&a);
+	clear(&b);
+	/* aliased dividend and divisor */
+	refdivmod(&q, &r, &opb, &opb);
+	a = load(&opb);
+	quorem(&a, &m, a);
+	check(a, &q, 1, "aliased quotient");
+	check(m, &r, 1, "aliased remainder");
+	clear(&a);
+	a = load(&opb);
+	opname = "quo";
+	quo(&a, a);
+	check(a, &q, 1, "aliased");
+	clear(&a);
+	a = load(&opb);
+	opname = "rem";
+	rem(&a, a);
+	check(a, &r, 1, "aliased");
+	clear(&a);
+	/* cleared numbers are zero and results are allocated again */
+	refset(&q, 0);
+	b = load(&opb);
+	opname = "quorem";
+	quorem(&a, &m, b);
+	check(a, &q, 1, "cleared dividend");
+	check(m, &q, 1, "cleared dividend");
+	clear(&a);
+	clear(&m);
+	a = load(&opa);
+	refdivmod(&q, &r, &opa, &opb);
+	quorem(&a, &m, b);
+	check(a, &q, 1, "quotient, cleared remainder");
+	check(m, &r, 1, "cleared remainder");
+	clear(&a);
+	refset(&q, 0);
+	opname = "quo";
+	quo(&a, b);
+	check(a, &q, 1, "cleared dividend");
+	clear(&a);
+	opname = "rem";
+	rem(&a, b);
+	check(a, &q, 1, "cleared dividend");
+	clear(&a);
+	clear(&b);
+	clear(&m);
+}
+
+static void testbits(void)
+{
+	Ref want, zero;
+	ulong bit = rnd() % ((opa.len + 2)*CHUNKBITS);
+	Number a = load(&opa), b = load(&opb);
+	opname = "testbit";
+	if (testbit(a, bit) != reftestbit(&opa, bit))
+		failint("result", testbit(a, bit), reftestbit(&opa, bit));
+	opname = "setbit";
+	setbit(&a, bit);
+	refputbit(&want, &opa, bit, 1);
+	check(a, &want, 1, "result");
+	opname = "clrbit";
+	clrbit(&a, bit);
+	refputbit(&want, &opa, bit, 0);
+	check(a, &want, 1, "result");
+	opname = "not";
+	clear(&a);
+	a = load(&opa);
+	not(&a);
+	refset(&want, 0);
+	refxor(&want, &opa, &(Ref){1, {1}, 1}); /* ~a == a ^ -1 */
+	check(a, &want, 1, "result");
+	opname = "popcount";
+	refset(&zero, 0);
+	if (popcount(b) != refhamming(&opb, &zero))
+		failint("result", popcount(b), refhamming(&opb, &zero));
+	opname = "hamming";
+	clear(&a);
+	a = load(&opa);
+	if (hamming(a, b) != refhamming(&opa, &opb))
+		failint("result", hamming(a, b), refhamming(&opa, &opb));
+	opname = "ctz";
+	ulong t = 0;
+	if (refzero(&opa))
+		t = ~0UL;
+	while (~t && !reftestbit(&opa, t))
+		t++;
+	if (ctz(a) != t)
+		failint("result", ctz(a), t);
+	clear(&a);
+	clear(&b);
+}
+
+/* cleared numbers are zero and results are allocated again */
+static void testclearedbits(void)
+{
+	Ref want;
+	ulong bit = rnd() % (2*CHUNKBITS);
+	Number a = {}, b = load(&opb), z = {};
+	opname = "and";
+	and(&a, b);
+	refset(&want, 0);
+	check(a, &want, 1, "cleared dst");
+	clear(&a);
+	a = load(&opa);
+	and(&a, z);
+	check(a, &want, 1, "cleared src");
+	clear(&a);
+	and(&a, z);
+	check(a, &want, 1, "both cleared");
+	clear(&a);
+	opname = "or";
+	or(&a, b);
+	check(a, &opb, 1, "cleared dst");
+	clear(&a);
+	opname = "xor";
+	xor(&a, b);
+	check(a, &opb, 1, "cleared dst");
+	clear(&a);
+	opname = "clrbit";
+	clrbit(&a, bit);
+	check(a, &want, 1, "cleared");
+	clear(&a);
+	opname = "setbit";
+	setbit(&a, bit);
+	refputbit(&want, &want, bit, 1);
+	check(a, &want, 1, "cleared");
+	clear(&a);
+	opname = "not";
+	not(&a);
+	refset(&want, 1);
+	want.neg = 1;
+	check(a, &want, 1, "cleared");
+	clear(&a);
+	clear(&b);
+}
+
+static void testcmp(void)
+{
+	Ref diff;
+	Number a = load(&opa), b = load(&opb);
+	opname = "cmp";
+	refsub(&diff, &opa, &opb);
+	int want = refzero(&diff) ? 0 : diff.neg ? -1 : 1;
+	int c = cmp(a, b);
+	if ((c > 0) - (c < 0) != want)
+		failint("result", c, want);
+	opname = "bitlen";
+	if (bitlen(a) != refbitlen(&opa))
+		failint("result", bitlen(a), refbitlen(&opa));
+	clear(&a);
+	clear(&b);
+}
+
+static void testread10(void)
+{
+	Number a = number(0);
+	opname = "read10";
+	if (read(&a, refdec(&opa)))
+		fail("rejected", a, &opa);
+	check(a, &opa, 1, "result");
+	clear(&a);
+}
+
+int main(int argc, char **argv)
+{
+	seed = argc > 1 ? strtoul(argv[1], 0, 0) : 1;
+	ulong iters = argc > 2 ? strtoul(argv[2], 0, 0) : 2000;
+	state = seed * 0x9e3779b97f4a7c15UL | 1;
+	for (iter = 0; iter < iters; iter++) {
+		refgen(&opa);
+		refgen(&opb);
+		if (rnd() % 8 == 0)
+			opb = opa, opb.neg = rnd() % 2; /* equal magnitudes */
+		testbin("add", add, refadd);
+		testbin("sub", sub, refsub);
+		testbin("mul", mul, refmul);
+		testbin("and", and, refand);
+		testbin("or", or, refor);
+		testbin("xor", xor, refxor);
+		testbits();
+		testclearedbits();
+		testassign();
+		testshift();
+		testsmall();
+		testsquare();
+		testdiv();
+		testcmp();
+		testread10();
+	}
+	printf("ok: %lu iterations, seed %lu\n", iters, seed);
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bignum.h"
+
+
+/* Fuzzing entry point. The input is a program for a tiny register
+ * machine: every instruction is three bytes (opcode, x, y) and works on
+ * registers r[x] and r[y]; the read instruction is followed by y bytes
+ * of text that are passed to read(). After every instruction a few
+ * identities that must hold for any numbers are checked.
+ *
+ * With -DLIBFUZZER it is a libFuzzer target, otherwise it runs the
+ * inputs from the files given as arguments (or stdin), which is what
+ * AFL and replaying crashes need. */
+
+#define NREGS   4
+#define MAXBITS 4096 /* keep squaring and shifting from blowing up */
+#define MAXLEN  4096
+
+enum {
+	READ, ADD, SUB, MUL, SQUARE, QUOREM, QUO, REM,
+	LSHIFT, RSHIFT, INC, DEC, NEGATE, ASSIGN,
+	AND, OR, XOR, NOT, SETBIT, CLRBIT, NOPS
+};
+
+static Number abscopy(Number n)
+{
+	Number c = copy(n);
+	c.neg = 0;
+	return c;
+}
+
+/* (a + b) - b == a */
+static void checkadd(Number a, Number b)
+{
+	Number t = copy(a);
+	add(&t, b);
+	sub(&t, b);
+	assert(!cmp(t, a));
+	clear(&t);
+}
+
+/* a*b == b*a and (a*b)/b == a */
+static void checkmul(Number a, Number b)
+{
+	Number ab = copy(a), ba = copy(b), r = number(0);
+	mul(&ab, b);
+	mul(&ba, a);
+	assert(!cmp(ab, ba));
+	if (!iszero(b)) {
+		quorem(&ab, &r, b);
+		assert(!cmp(ab, a) && iszero(r));
+	}
+	clear(&ab);
+	clear(&ba);
+	clear(&r);
+}
+
+/* a == a/b * b + a%b and |a%b| < |b| */
+static void checkdiv(Number a, Number b)
+{
+	if (iszero(b))
+		return;
+	Number q = copy(a), r = number(0), m = abscopy(b);
+	quorem(&q, &r, b);
+	Number t = abscopy(r);
+	assert(cmp(t, m) < 0);
+	mul(&q, b);
+	add(&q, r);
+	assert(!cmp(q, a));
+	clear(&q);
+	clear(&r);
+	clear(&m);
+	clear(&t);
+}
+
+static void checkshift(Number a, uint bits)
+{
+	Number t = copy(a);
+	lshift(&t, bits);
+	assert(bitlen(t) == (iszero(a) ? 0 : bitlen(a) + bits));
+	rshift(&t, bits);
+	assert(!cmp(t, a));
+	clear(&t);
+}
+
+/* (a & b) + (a | b) == a + b, (a ^ b) + (a & b) == a | b
+ * and popcount(a ^ b) == hamming(a, b) */
+static void checkbits(Number a, Number b)
+{
+	Number x = copy(a), y = copy(a), t = copy(a), s = copy(a);
+	and(&x, b);
+	or(&y, b);
+	xor(&t, b);
+	add(&s, b);
+	assert(popcount(t) == hamming(a, b));
+	add(&t, x);
+	assert(!cmp(t, y));
+	add(&x, y);
+	assert(!cmp(x, s));
+	clear(&x);
+	clear(&y);
+	clear(&t);
+	clear(&s);
+}
+
+int LLVMFuzzerTestOneInput(const uchar *data, size_t size)
+{
+	static char buf[MAXLEN+1];
+	Number r[NREGS];
+	for (uint i = 0; i < NREGS; i++)
+		r[i] = number(0);
+	for (size_t i = 0; i + 3 <= size;) {
+		uint op = data[i] % NOPS;
+		Number *x = &r[data[i+1] % NREGS], *y = &r[data[i+2] % NREGS];
+		uint arg = data[i+2];
+		i += 3;
+		if (op != READ && op != RSHIFT && (bitlen(*x) > MAXBITS || bitlen(*y) > MAXBITS))
+			continue;
+		switch (op) {
+		case READ:
+			if (arg > size - i)
+				arg = size - i;
+			memcpy(buf, data + i, arg);
+			buf[arg] = '\0';
+			i += arg;
+			if (read(x, buf))
+				zero(x);
+			break;
+		case ADD:    add(x, *y); break;
+		case SUB:    sub(x, *y); break;
+		case MUL:    mul(x, *y); break;
+		case SQUARE: square(x); break;
+		case QUOREM:
+			if (!iszero(*y) && x != y) {
+				Number m = number(0);
+				quorem(x, &m, *y);
+				move(y, &m);
+			}
+			break;
+		case QUO:    if (!iszero(*y)) quo(x, *y); break;
+		case REM:    if (!iszero(*y)) rem(x, *y); break;
+		case LSHIFT: lshift(x, arg); break;
+		case RSHIFT: rshift(x, arg); break;
+		case INC:    inc(x, arg); break;
+		case DEC:    dec(x, arg); break;
+		case NEGATE: negate(x); break;
+		case ASSIGN: assign(x, *y); break;
+		case AND:    and(x, *y); break;
+		case OR:     or(x, *y); break;
+		case XOR:    xor(x, *y); break;
+		case NOT:    not(x); break;
+		case SETBIT: setbit(x, arg); break;
+		case CLRBIT: clrbit(x, arg); break;
+		}
+		checkadd(*x, *y);
+		checkmul(*x, *y);
+		checkdiv(*x, *y);
+		checkshift(*x, arg);
+		checkbits(*x, *y);
+	}
+	for (uint i = 0; i < NREGS; i++)
+		clear(&r[i]);
+	return 0;
+}
+
+#ifndef LIBFUZZER
+static void run(FILE *f)
+{
+	size_t len = 0, cap = 4096;
+	uchar *data = malloc(cap);
+	for (size_t n; (n = fread(data + len, 1, cap - len, f)) > 0;) {
+		len += n;
+		if (len == cap)
+			data = realloc(data, cap *= 2);
+	}
+	LLVMFuzzerTestOneInput(data, len);
+	free(data);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		run(stdin);
+	for (int i = 1; i < argc; i++) {
+		FILE *f = fopen(argv[i], "rb");
+		if (!f) {
+			printf("error: can't open %s\n", argv[i]);
+			return 1;
+		}
+		run(f);
+		fclose(f);
+	}
+	return 0;
+}
+#endif
@@ -82,6 +82,38 @@ int main(void)
 	read(&a, "0xc19c644d57e521365db55f1e774ced353bb50b56c0308ed4ff3d46668b1e440735403f9e71cf07d8bc276f359c3a354ac7b08032a4c42e4545d88908fe5e95398a3a24c6fc55247c0fcfc79c7f28d0b3ad6ceea38386fd8921e81b543748c033bcc129e19ffb3258210fc8700e9984da0cba40a32a31c09dbaf0a8d18198b91e3da1f4dda66f8bc41b1c2fb7dbbf85a65110f187d0ad00bd11881a1b4301ebdf6a05103371fa296dd0a12381a6f5dcd0ff5f13ce58aa70a69c960cb78d01cb1c9c2b9688fa7ce33ac5907b5db3d8fd1ca8453dacb24cf1cd6d85cd81ed6ab65710682681c5d98fea186f32e72dff024cb346740602ef82b68fad5aca3d14b1d074fb8418dc0c46659363b144a1c2959e8ac9b323dd3b67f9d33e179f86424205a578d60e6391b42d1438f7cf627b7768ecc9f616ac1fd2a88b55c09047a28990292c8a23b8779584b9d34cd4145e3093879b6323391afee237e026344c711703f73a30ddbf0f00b41a39dc30356f3b4ffcf165040922fcd368ef06eabda5b9c9ec03daf5ba638880353acea70b60f20470d6430fdb8d2a3fa4bd87fb2c25acfb3bdffdba9c93223df1a969eed70c89a6b62864f975b71678cd039c21ac8300eb19df3833485502d5949ee4cd75630edebdf7b805a938ff32236e8e8ca52ca4fc61dde70952f7f1959666d84b32a8383df123026a54344aafdb0968320a613f34956d0922aba2e1a8ba264b2b7c6b987604eb3ec731a5459d833d49ce6e737ce480ddae6557c4041e16e06174cc4efec4c95aa3e8b40784d4c87c8de573fc5191bb0f17bdd5b5ce0bd964077bc6112c3a3fd18fa203c4bcd43dfed9203f2a3d044e53b2f96c3007aefe24fd317bea3382d19e0a10f4c88e054");
 	square(&a);
 	expect(a, "0x926d2ec704171f5d7383ac0951b265ca896f047c7bcfeda146b577265a86920a6c8a757c753c7ddfe5482c2c0691ae929a37404967f4d4b3c9e387a49562451a8d871ed990fb1b1c5d8f377a4e30a74b5d8aad51758e4c1bfcb9e15ce29bbfb6e38b689c722bf4b9ee7d396311e2c096a5bc7dc5609ac8f97bdfcbb3005c03f3c6fd98edbf2ccb0bd425d24b33f0223fba4a1ab9006072c7dba5d73592180925341b03cc553a46ce59f0a2a8f651a24405fb51f5afe77f401d16d05a0e4b687e99067bf1bc59ea5fcffc8b24d3577f402d49c523c20573aa8c09c4be8ab9772dad854471405dcad8a3b445d268d69890cb9fa098df39f185c7d8026c61a1914f3690dc9c1a5b3afd23b214a87ed8333ba22d1a9114b9eac6bce79b52e6612bcc17712a329e4f612326e1b7b8991d422df904558ea7b228e2962e9501ae4273e0217dc16aaa95157c31b4b2aeb8bc659caa074e2c6ce02867577727b6dc6f02ae45b2366b9684d99df576bea7d4f692d98786469be04688c60112bdb428ed68d5959f21e0caed7a4119f362e58a9794a4ef9dbd139a0713881133507359110c72c8199dead9d62ce773fac87b2bbe9173433677d814f9126d1b634cb5daa546a93f8e280ba281a20d936f4847c7866737f2fdb281dc0232f279359bd3ac91cd77c9fec9077ad9a521511dc997c74eede5993b507f8dcd68834bf61959901f5e0a824f57d475920a2737f3f08105417eefe7b371257532aa03be0c6a7b45a14d166c84292d13d90f8bf63ae8a8a0e015d1f3a44e16165c46e2ecf376680d5da25dc98365fe6bf39f42bd8c2a76501ec10083b00c175ae9856a9f381e592480360af1822b7fa7dc6d42528c99b34ade417d41ae153d9d3dcbd8114bda4adefe8f9f0a623949cf651027028926f96cac5dea67313ce6142c2a1386911ef9c787c9c10985a2e0d9ed5a42cfa25a4302fe957cef7e30bc4a47ee5694a24f93959f68b725977deccd8df61210784fc59db8734235d1a8ffc4d135b1070b25a65e75edd6b4afab5ba6885c291255928bfa06db8f8269734640795657746f8aed3f8d832fd46d7ecee24637f1309da64fb4735c95081135f19108deaecb8c0c1fa98b6f7d922a4f100522dd2e2a23d26cc8700ccdee0fce3877c84bbe92ae5b3f9457f45551fb793a913b186d7b1d1bf0e02f649f281f008b1237a59a3fa219f3383327f06d06ed43e4cf677501ccc45fcff6c06ae6b8f612299a9b8796f38134adfd4c74c3f48e1f356fde9a9ea4eb2712d4f253d9d37ae75648e4bb96de6d5084ebf0ddc1f1a6500ebc466d6d8e62abc06e0dcc82d230339325471936aacd71dda8dd3bdfeca58f47ce2a01e660a5d7d309873a67ff5c062d4ec3c84087d6043a5088d06c088ece978a6407174474929bce0a6d21ec441c47c0a30a6df19703c9e90b34b124b4478ae294bf7c76269085f53defe996bed0d8b3f793b9815ead429fbe62719add32a733430f97d6ef5dab6e4c4f868f6483c0730267b270c41634d9c0551a96cd9dd58610a03734011ac2a2e12da9266b60df8234bdf6a9067a597577dc2afbb0dcefc4cc7f34fb1e68aadfccb10dd6fc3bcaecd4110584508a6a21e007b3e5d9d86a9f47f6dbb44b5a72473c402fb5565d12cc026d72e7d08dec1f74c95a183f8c7cdc0f1a2e07e06776266b5362a86ee8f008867375f4a27e7165d4ac89f9cb38d9cc05d21564c3106f14013a14ef926826199c45b4867144ec37fe24b4575e5fce6248880f34158038fdd31b90");
+	/* and/or/xor/not */
+	read(&a, "0x98417ddf5a83fd44250657f93b9fd8e6e463b2320f8d1ff3");
+	read(&b, "-0xae5b45cc7dfcefdcb10db748a6d9c2ef");
+	assign(&c, a);
+	and(&c, b);
+	expect(c, "0x98417ddf5a83fd4401041231020310224462003209041d11");
+	assign(&c, a);
+	or(&c, b);
+	expect(c, "-0x8a59000444602718110c0548a050c00d");
+	xor(&a, b);
+	expect(a, "-0x98417ddf5a83fd448b5d12354663373a556e057aa954dd1e");
+	not(&b);
+	expect(b, "0xae5b45cc7dfcefdcb10db748a6d9c2ee");
+	/* setbit/clrbit/testbit */
+	read(&a, "-0x10000000000000000");
+	assert(!testbit(a, 63) && testbit(a, 64) && testbit(a, 100));
+	setbit(&a, 100);
+	expect(a, "-0x10000000000000000");
+	clrbit(&a, 64);
+	expect(a, "-0x20000000000000000");
+	assert(ctz(a) == 65);
+	read(&c, "0x0");
+	assert(ctz(c) == ~0UL);
+	setbit(&a, 0);
+	expect(a, "-0x1ffffffffffffffff");
+	/* popcount/hamming */
+	read(&a, "0x98417ddf5a83fd44250657f93b9fd8e6e463b2320f8d1ff3");
+	read(&b, "-0xae5b45cc7dfcefdcb10db748a6d9c2ef");
+	assert(popcount(a) == 104);
+	assert(popcount(b) == ~0UL);
+	negate(&a);
+	assert(hamming(a, b) == 97);
 	clear(&a);
 	clear(&b);
 	clear(&c);